@@ -55,6 +55,31 @@ struct InputPin {
   register8_t bitmask;
 };
 
+// The number of PWM periods to wait after each change of the PWM duty cycle
+// before reading the receiver's output.
+constexpr uint16_t kSettlePeriods = 4;
+// The number of PWM periods the receiver needs to recover after switching from
+// one LED to the other. The carrier never pauses, so the switch only changes
+// the received amplitude, just like a change of the duty cycle within a search.
+// The burst and gap limits of the TSSP60 datasheet
+// (https://www.vishay.com/docs/82483/tssp60.pdf) concern pauses of the carrier
+// and don't apply here.
+constexpr uint16_t kReceiverRecoveryPeriods = kSettlePeriods;
+// The first step of a search starts together with the switch of the LEDs, so
+// the receiver's recovery and the settling of the first duty cycle overlap.
+constexpr uint16_t kFirstStepPeriods =
+    max(kSettlePeriods, kReceiverRecoveryPeriods);
+// The number of steps of each binary search, one per bit of the result.
+constexpr uint16_t kSearchSteps = 8;
+
+constexpr float kLedPwmHz = 1.0;
+constexpr const TCA0_PWM::Config kLedPwmFreq(kLedPwmHz);
+// The nominal duration of measuring both LEDs, in seconds.
+constexpr float kNominalRound =
+    2 * (kFirstStepPeriods + (kSearchSteps - 1) * kSettlePeriods) / kLedPwmHz;
+// Leaves enough room for the main loop, TWI and sleep latencies.
+constexpr const RtcCounter::Config kSampleClock(4 * kNominalRound);
+
 struct Registers {
  public:
   void Snapshot() {}
@@ -65,6 +90,13 @@ struct Registers {
         return led1.fraction_bits;
       case 1:
         return led2.fraction_bits;
+      case 2:
+        if (!sample_period) {
+          return {};
+        }
+        return static_cast<int16_t>(*sample_period);
+      case 3:
+        return static_cast<int16_t>(kSampleClock.freq());
       default:
         return {};
     }
@@ -72,46 +104,52 @@ struct Registers {
 
   FixedPointFraction<int16_t, 15> led1 = 0;
   FixedPointFraction<int16_t, 15> led2 = 0;
+  // The measured time between the two last results of LED1, in ticks of
+  // `kSampleClock`. Empty until the second result is available.
+  optional<uint16_t> sample_period;
 };
 
 using TwiRegisters = TwiClient<SMBusClient<Registers&>>;
 
 class BinarySearch {
  public:
-  using value_type = FixedPointFraction<int_fast16_t, 8>;
+  using value_type = FixedPointFraction<int_fast16_t, kSearchSteps>;
 
   BinarySearch(TCB0Delay& delay, TCA0_PWM& pwm, InputPin input)
-      : delay_(delay),
-        pwm_(pwm),
-        input_(input),
-        lower_(0),
-        upper_(value_type(1.0f).fraction_bits - 1) {
-    SetPwm();
+      : delay_(delay), pwm_(pwm), input_(input), lower_(0), upper_(0) {}
+
+  // Starts a new search right after the LEDs have been switched.
+  void Start() {
+    lower_ = 0;
+    upper_ = value_type(1.0f).fraction_bits - 1;
+    SetPwm(kFirstStepPeriods);
   }
 
   // Returns the measured return value in [0..1], or a negative value if not
-  // available yet.
+  // available yet. The result is returned as soon as the last step is
+  // decided, without starting another delay.
   value_type OnInterrupt() {
+    if (!delay_.HasTriggered()) {
+      return value_type{-1};
+    }
+    if (input_.Read()) {
+      lower_ = middle();
+    } else {
+      upper_ = middle() - 1;
+    }
     if (upper_ == lower_) {
       return value_type(lower_);
     }
-    if (delay_.HasTriggered()) {
-      if (input_.Read()) {
-        lower_ = middle();
-      } else {
-        upper_ = middle() - 1;
-      }
-      SetPwm();
-    }
+    SetPwm(kSettlePeriods);
     return value_type{-1};
   }
 
  private:
-  void SetPwm() {
+  void SetPwm(uint16_t delay_periods) {
     // Divide by 2 so that the maximum value for PWM is 0.5 - at which
     // the signal at the base frequency is the strongest.
     pwm_.SetDutyCycle(value_type{middle()}.ShiftRight<1>());
-    delay_.Start();
+    delay_.Start(delay_periods);
   }
 
   // As long as `upper_ > lower_`, the result is always `> _lower`.
@@ -127,19 +165,51 @@ class BinarySearch {
   value_type::value_type upper_;
 };
 
-BinarySearch::value_type BinarySearchLoop(TCA0_PWM& pwm, TCB0Delay& delay,
-                                          TwiRegisters& twi, Sleep& sleep,
-                                          InputPin opt_in) {
-  BinarySearch search(delay, pwm, opt_in);
-  BinarySearch::value_type signal(0);
-  while ((signal = search.OnInterrupt()).fraction_bits < 0) {
-    sleep.Start();
-    twi.OnInterrupt();
+// Alternates binary searches between LED1 (PA5) and LED2 (PA6).
+// The LEDs are switched and the next search is started as soon as the last
+// step of a search is decided. The first step of the next search waits
+// `kFirstStepPeriods`, which covers the receiver's recovery.
+class LedScheduler {
+ public:
+  LedScheduler(TCB0Delay& delay, TCA0_PWM& pwm, InputPin input,
+               const RtcCounter& clock, Registers& regs)
+      : search_(delay, pwm, input), clock_(clock), regs_(regs), led1_(true) {
+    PORTA.OUTCLR = PIN6_bm;
+    PORTA.OUTSET = PIN5_bm;
+    search_.Start();
+  }
+  LedScheduler(const LedScheduler&) = delete;
+  LedScheduler& operator=(const LedScheduler&) = delete;
+
+  void OnInterrupt() {
+    const BinarySearch::value_type signal = search_.OnInterrupt();
+    if (signal.fraction_bits < 0) {
+      return;
+    }
+    // Exactly one LED is on, so a single write switches both.
+    PORTA.OUTTGL = PIN5_bm | PIN6_bm;
+    search_.Start();
+    if (exchange(led1_, !led1_)) {
+      regs_.led1 = signal.Convert();
+      const uint16_t now = clock_.Count();
+      if (last_led1_) {
+        regs_.sample_period = static_cast<uint16_t>(now - *last_led1_);
+      }
+      last_led1_ = now;
+    } else {
+      regs_.led2 = signal.Convert();
+    }
   }
-  return signal;
-}
 
-constexpr const TCA0_PWM::Config kLedPwmFreq(1.0);
+ private:
+  BinarySearch search_;
+  const RtcCounter& clock_;
+  Registers& regs_;
+  // Whether LED1 is currently on.
+  bool led1_;
+  // The clock count at the last result of LED1.
+  optional<uint16_t> last_led1_;
+};
 
 int main(void) {
   Sleep sleep(SLPCTRL_SMODE_IDLE_gc);
@@ -158,14 +228,13 @@ int main(void) {
   TCA0_PWM pwm(kLedPwmFreq);
   EVSYS.CHANNEL0 = EVSYS_CHANNEL0_TCA0_CMP0_LCMP0_gc;
 
-  TCB0Delay delay(4, EVSYS_USER_CHANNEL0_gc);
+  TCB0Delay delay(kSettlePeriods, EVSYS_USER_CHANNEL0_gc);
+  const RtcCounter clock(kSampleClock);
+  LedScheduler scheduler(delay, pwm, kOptIn, clock, regs);
   while (true) {
-    PORTA.OUTCLR = PIN6_bm;
-    PORTA.OUTSET = PIN5_bm;
-    regs.led1 = BinarySearchLoop(pwm, delay, twi, sleep, kOptIn).Convert();
-    PORTA.OUTCLR = PIN5_bm;
-    PORTA.OUTSET = PIN6_bm;
-    regs.led2 = BinarySearchLoop(pwm, delay, twi, sleep, kOptIn).Convert();
+    scheduler.OnInterrupt();
+    sleep.Start();
+    twi.OnInterrupt();
   };
   EVSYS.CHANNEL0 = EVSYS_CHANNEL0_OFF_gc;
 }
@@ -0,0 +1,81 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Hand-written counterpart of `codegen_util.cc`. See there.
+
+extern "C" {
+
+#include <stddef.h>
+#include <stdint.h>
+
+}  // extern "C"
+
+struct OptionalByte {
+  uint8_t value;
+  bool has_value;
+};
+
+struct ByteQueue {
+  uint8_t elements[16];
+  volatile uint8_t head;
+  volatile uint8_t tail;
+};
+
+ByteQueue queue;
+uint8_t table[4];
+
+static OptionalByte Pop() {
+  const uint8_t tail = queue.tail;
+  if (queue.head == tail) {
+    return OptionalByte{0, false};
+  }
+  __asm__ __volatile__("" ::: "memory");
+  const uint8_t value = queue.elements[tail & (sizeof(queue.elements) - 1)];
+  __asm__ __volatile__("" ::: "memory");
+  queue.tail = tail + 1;
+  return OptionalByte{value, true};
+}
+
+extern "C" {
+
+OptionalByte Some(uint8_t value) { return OptionalByte{value, true}; }
+
+uint8_t ValueOr(OptionalByte value, uint8_t default_value) {
+  return value.has_value ? value.value : default_value;
+}
+
+static uint8_t Sum(const uint8_t* elements, size_t size) {
+  uint8_t sum = 0;
+  for (const uint8_t* end = elements + size; elements != end; elements++) {
+    sum += *elements;
+  }
+  return sum;
+}
+
+uint8_t SumTable() { return Sum(table, sizeof(table)); }
+
+bool Push(uint8_t value) {
+  const uint8_t head = queue.head;
+  if (static_cast<uint8_t>(head - queue.tail) == sizeof(queue.elements)) {
+    return false;
+  }
+  queue.elements[head & (sizeof(queue.elements) - 1)] = value;
+  __asm__ __volatile__("" ::: "memory");
+  queue.head = head + 1;
+  return true;
+}
+
+uint8_t PopOr(uint8_t default_value) { return ValueOr(Pop(), default_value); }
+
+}  // extern "C"
@@ -0,0 +1,55 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Uses the abstractions from `util.h`. `make codegen` compiles this file and
+// `codegen_manual.cc`, which implements the same functions by hand, for AVR
+// and diffs their disassembly. Both files must define the same symbols.
+
+#include "util.h"
+
+static_assert(__is_trivially_copyable(optional<uint8_t>),
+              "optional<uint8_t> must be passed in registers");
+static_assert(sizeof(optional<uint8_t>) == 2,
+              "optional<uint8_t> must be a value and a flag");
+static_assert(sizeof(RingBuffer<uint8_t, 16>) == 16 + 2,
+              "RingBuffer must be just the elements and two indices");
+
+RingBuffer<uint8_t, 16> queue;
+array<uint8_t, 4> table;
+
+extern "C" {
+
+optional<uint8_t> Some(uint8_t value) { return value; }
+
+uint8_t ValueOr(optional<uint8_t> value, uint8_t default_value) {
+  return value.value_or(default_value);
+}
+
+static uint8_t Sum(span<const uint8_t> elements) {
+  uint8_t sum = 0;
+  for (uint8_t element : elements) {
+    sum += element;
+  }
+  return sum;
+}
+
+uint8_t SumTable() { return Sum(table); }
+
+bool Push(uint8_t value) { return queue.Push(value); }
+
+uint8_t PopOr(uint8_t default_value) {
+  return queue.Pop().value_or(default_value);
+}
+
+}  // extern "C"
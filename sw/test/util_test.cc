@@ -0,0 +1,240 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Host unit tests for `util.h`. Built and run by `make test`.
+
+#include "util.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// The properties below are what allows `optional` to be passed and returned
+// in registers on AVR, just like a hand-written value and flag pair.
+static_assert(__is_trivially_copyable(optional<uint8_t>),
+              "optional<uint8_t> must be trivially copyable");
+static_assert(__is_trivially_copyable(optional<int16_t>),
+              "optional<int16_t> must be trivially copyable");
+// Required by `optional::emplace` to start the lifetime of its value.
+static_assert(__is_trivially_constructible(uint8_t) &&
+                  __is_trivially_constructible(int16_t),
+              "optional's values must be trivially default constructible");
+static_assert(sizeof(optional<uint8_t>) == 2,
+              "optional<uint8_t> must be a value and a flag");
+static_assert(__is_trivially_copyable(span<uint8_t>),
+              "span must be trivially copyable");
+static_assert(sizeof(array<uint8_t, 3>) == 3, "array must have no overhead");
+static_assert(sizeof(RingBuffer<uint8_t, 16>) == 16 + 2,
+              "RingBuffer must be just the elements and two indices");
+
+static_assert(max(4, 10) == 10 && max(10, 4) == 10 && max(4, 4) == 4,
+              "max must return the larger value");
+
+static int failures = 0;
+
+#define EXPECT(condition)                                                  \
+  do {                                                                     \
+    if (!(condition)) {                                                    \
+      fprintf(stderr, "%s:%d: EXPECT(%s) failed\n", __FILE__, __LINE__, \
+              #condition);                                                 \
+      failures++;                                                          \
+    }                                                                      \
+  } while (false)
+
+static void TestOptional() {
+  optional<uint8_t> empty;
+  EXPECT(!empty.has_value());
+  EXPECT(!empty);
+  EXPECT(empty.value_or(7) == 7);
+
+  optional<uint8_t> value(3);
+  EXPECT(value.has_value());
+  EXPECT(*value == 3);
+  EXPECT(value.value_or(7) == 3);
+
+  EXPECT(empty.emplace(5) == 5);
+  EXPECT(empty.has_value());
+  EXPECT(*empty == 5);
+  // Emplacing over an existing value replaces it.
+  empty.emplace(6);
+  EXPECT(*empty == 6);
+  empty.reset();
+  EXPECT(!empty.has_value());
+  EXPECT(empty.value_or(7) == 7);
+  // Resetting an empty value is a no-op.
+  empty.reset();
+  EXPECT(!empty.has_value());
+
+  // Copies are independent.
+  optional<uint8_t> copy = value;
+  copy.emplace(9);
+  EXPECT(*value == 3);
+  EXPECT(*copy == 9);
+
+  struct Pair {
+    int16_t first;
+    int16_t second;
+  };
+  optional<Pair> pair;
+  pair.emplace(Pair{1, 2});
+  EXPECT(pair->first == 1);
+  EXPECT(pair->second == 2);
+
+  constexpr optional<int16_t> kConstant(-5);
+  static_assert(kConstant.has_value(), "constexpr optional must have a value");
+  static_assert(*kConstant == -5, "constexpr optional must hold its value");
+}
+
+static void TestArray() {
+  array<uint8_t, 4> elements = {{1, 2, 3, 4}};
+  EXPECT(elements.size() == 4);
+  EXPECT(elements[0] == 1);
+  EXPECT(elements[3] == 4);
+  elements[1] = 20;
+  EXPECT(elements.data()[1] == 20);
+  EXPECT(elements.end() - elements.begin() == 4);
+  int sum = 0;
+  for (uint8_t element : elements) {
+    sum += element;
+  }
+  EXPECT(sum == 1 + 20 + 3 + 4);
+
+  // Arrays are copied by value.
+  array<uint8_t, 4> copy = elements;
+  copy[0] = 100;
+  EXPECT(elements[0] == 1);
+
+  const array<uint8_t, 4>& const_ref = elements;
+  EXPECT(const_ref[2] == 3);
+  EXPECT(*const_ref.begin() == 1);
+}
+
+static void TestSpan() {
+  span<uint8_t> empty;
+  EXPECT(empty.empty());
+  EXPECT(empty.size() == 0);
+  EXPECT(empty.begin() == empty.end());
+
+  uint8_t raw[5] = {10, 11, 12, 13, 14};
+  span<uint8_t> all(raw);
+  EXPECT(all.size() == 5);
+  EXPECT(!all.empty());
+  EXPECT(all.data() == raw);
+  all[2] = 42;
+  EXPECT(raw[2] == 42);
+
+  span<uint8_t> first = all.first(2);
+  EXPECT(first.size() == 2);
+  EXPECT(first.data() == raw);
+  EXPECT(first[1] == 11);
+
+  span<uint8_t> last = all.last(2);
+  EXPECT(last.size() == 2);
+  EXPECT(last.data() == raw + 3);
+  EXPECT(last[0] == 13);
+
+  span<uint8_t> middle = all.subspan(1, 3);
+  EXPECT(middle.size() == 3);
+  EXPECT(middle[0] == 11);
+  EXPECT(middle[2] == 13);
+  EXPECT(middle.subspan(1, 0).empty());
+
+  array<uint8_t, 3> elements = {{1, 2, 3}};
+  span<uint8_t> from_array(elements);
+  EXPECT(from_array.size() == 3);
+  from_array[0] = 7;
+  EXPECT(elements[0] == 7);
+
+  const array<uint8_t, 3>& const_elements = elements;
+  span<const uint8_t> from_const(const_elements);
+  EXPECT(from_const.size() == 3);
+  EXPECT(from_const[0] == 7);
+  int sum = 0;
+  for (uint8_t element : from_const) {
+    sum += element;
+  }
+  EXPECT(sum == 7 + 2 + 3);
+}
+
+static void TestRingBufferFullEmpty() {
+  RingBuffer<uint8_t, 4> buffer;
+  EXPECT(buffer.capacity() == 4);
+  EXPECT(buffer.IsEmpty());
+  EXPECT(!buffer.IsFull());
+  EXPECT(buffer.Size() == 0);
+  EXPECT(!buffer.Pop().has_value());
+
+  for (uint8_t i = 0; i < 4; i++) {
+    EXPECT(buffer.Push(i));
+    EXPECT(buffer.Size() == i + 1);
+  }
+  EXPECT(buffer.IsFull());
+  EXPECT(!buffer.Push(99));  // Dropped.
+  EXPECT(buffer.Size() == 4);
+
+  for (uint8_t i = 0; i < 4; i++) {
+    optional<uint8_t> value = buffer.Pop();
+    EXPECT(value.has_value());
+    EXPECT(value.value_or(0xff) == i);
+  }
+  EXPECT(buffer.IsEmpty());
+  EXPECT(!buffer.Pop().has_value());
+}
+
+// Runs enough elements through the buffer for both free-running indices to
+// wrap past 255 several times, with the buffer kept at each fill level.
+template <uint8_t Capacity>
+static void TestRingBufferWraparound() {
+  RingBuffer<uint16_t, Capacity> buffer;
+  uint16_t pushed = 0;
+  uint16_t popped = 0;
+  for (uint8_t fill = 1; fill <= Capacity; fill++) {
+    while (buffer.Size() < fill) {
+      EXPECT(buffer.Push(pushed++));
+    }
+    EXPECT(buffer.Size() == fill);
+    EXPECT(buffer.IsFull() == (fill == Capacity));
+    for (int i = 0; i < 600; i++) {
+      optional<uint16_t> value = buffer.Pop();
+      EXPECT(value.has_value());
+      EXPECT(value.value_or(0xffff) == popped);
+      popped++;
+      EXPECT(buffer.Push(pushed++));
+      EXPECT(buffer.Size() == fill);
+    }
+  }
+  EXPECT(buffer.IsFull());
+  EXPECT(!buffer.Push(0));
+  while (!buffer.IsEmpty()) {
+    EXPECT(buffer.Pop().value_or(0xffff) == popped);
+    popped++;
+  }
+  EXPECT(pushed == popped);
+  EXPECT(buffer.Size() == 0);
+}
+
+int main() {
+  TestOptional();
+  TestArray();
+  TestSpan();
+  TestRingBufferFullEmpty();
+  TestRingBufferWraparound<1>();
+  TestRingBufferWraparound<16>();
+  TestRingBufferWraparound<128>();
+  if (failures > 0) {
+    fprintf(stderr, "%d failure(s)\n", failures);
+    return EXIT_FAILURE;
+  }
+  printf("PASS\n");
+  return EXIT_SUCCESS;
+}
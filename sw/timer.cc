@@ -64,3 +64,21 @@ TCB0Delay::~TCB0Delay() {
 }
 
 EMPTY_INTERRUPT(TCB0_INT_vect);
+
+RtcCounter::RtcCounter(Config config) {
+  // Wait for any pending synchronization of the registers before writing.
+  while (RTC.STATUS) {}
+  RTC.CLKSEL = RTC_CLKSEL_INT32K_gc;
+  RTC.INTCTRL = 0;
+  RTC.PER = 0xFFFF;
+  RTC.CNT = 0;
+  while (RTC.STATUS) {}
+  // Enable last.
+  RTC.CTRLA = ((config.prescaler << RTC_PRESCALER_gp) & RTC_PRESCALER_gm) |
+              RTC_RTCEN_bm;
+}
+
+RtcCounter::~RtcCounter() {
+  while (RTC.STATUS) {}
+  RTC.CTRLA = 0;  // Disable.
+}
@@ -93,6 +93,12 @@ class TCB0Delay {
     TCB0.CNT = 0;
     EVSYS.SWEVENTA = trigger_event_;
   }
+  // Like `Start`, but first changes the number of counted input events to
+  // `count` for this and all subsequent runs.
+  void Start(uint16_t count) {
+    TCB0.CCMP = count - 1;
+    Start();
+  }
 
   bool IsRunning() const { return TCB0.STATUS & TCB_RUN_bm; }
   // Returns whether the delay has been reached and the interrupt invoked.
@@ -105,4 +111,44 @@ class TCB0Delay {
   const EVSYS_SWEVENTA_t trigger_event_;
 };
 
+// A free-running 16-bit counter of the real-time clock, driven by the internal
+// 32.768kHz oscillator. Used to measure elapsed time.
+class RtcCounter {
+ public:
+  struct Config {
+    // Selects the smallest prescaler for which `max_interval` (in seconds)
+    // still fits into the 16-bit counter, to get the best resolution.
+    constexpr explicit Config(float max_interval)
+        : prescaler(PrescalerFor(max_interval)) {}
+
+    // The frequency of counter ticks in Hz.
+    constexpr uint16_t freq() const {
+      return static_cast<uint16_t>(kOscFreq >> prescaler);
+    }
+
+    // The prescaler selection 0-15, dividing by `1 << prescaler`.
+    uint8_t prescaler;
+
+   private:
+    constexpr static uint8_t PrescalerFor(float max_interval) {
+      uint8_t prescaler = 0;
+      for (; prescaler < 15; prescaler++) {
+        if (max_interval * (kOscFreq >> prescaler) < 65536.0f) {
+          break;
+        }
+      }
+      return prescaler;
+    }
+    constexpr static long kOscFreq = 32768;
+  };
+
+  explicit RtcCounter(Config config);
+  RtcCounter(const RtcCounter&) = delete;
+  RtcCounter& operator=(const RtcCounter&) = delete;
+  ~RtcCounter();
+
+  // Differences of two values give the elapsed number of ticks (modulo 2^16).
+  uint16_t Count() const { return RTC.CNT; }
+};
+
 #endif  // _TIMER_H
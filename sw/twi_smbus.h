@@ -66,7 +66,7 @@ class SMBusClient {
     index_ = 0;
     optional<int16_t> data = registers_.ReadWord(*command_);
     if (!data.has_value()) {
-      index_ = sizeof(buffer_);
+      index_ = buffer_.size();
       return false;
     }
     buffer_[0] = static_cast<uint8_t>(*data & 0xff);  // Low byte first.
@@ -76,7 +76,7 @@ class SMBusClient {
   // Called to return the next value to be passed to the host.
   // Returning `-1` signals that there is no more data available.
   optional<uint8_t> Read() {
-    if (index_ < static_cast<intptr_t>(sizeof(buffer_))) {
+    if (index_ < buffer_.size()) {
       return buffer_[index_++];
     } else {
       return {};
@@ -86,8 +86,8 @@ class SMBusClient {
  private:
   Registers registers_;
   optional<uint8_t> command_;
-  intptr_t index_;
-  uint8_t buffer_[2];
+  uint8_t index_;
+  array<uint8_t, 2> buffer_;
 };
 
 #endif  // _TWI_SMBUS_H
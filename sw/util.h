@@ -17,12 +17,16 @@
 
 extern "C" {
 
+#include <stddef.h>
 #include <stdint.h>
 
 }  // extern "C"
 
+// A minimal freestanding replacement of the parts of the C++ standard library
+// used by this project (avr-libc doesn't provide one).
+
 template <typename T>
-T&& move(T& ref) {
+constexpr T&& move(T& ref) {
   return static_cast<T&&>(ref);
 }
 
@@ -33,51 +37,64 @@ T exchange(T& ref, U new_value) {
   return result;
 }
 
+template <typename T>
+constexpr const T& max(const T& a, const T& b) {
+  return a < b ? b : a;
+}
+
 template <typename T>
 struct identity {
   typedef T type;
 };
 // See https://stackoverflow.com/q/27501400/1333025.
 template <typename T>
-T&& forward(typename identity<T>::type& param) {
+constexpr T&& forward(typename identity<T>::type& param) {
   return static_cast<typename identity<T>::type&&>(param);
 }
 
+// Restricted to trivially copyable types, which makes `optional` itself
+// trivially copyable. Therefore small instances such as `optional<uint8_t>`
+// are passed and returned in registers, just like a hand-written pair of
+// a value and a flag. `T` must also be trivially default constructible, see
+// `emplace`.
 template <typename T>
 class optional {
+  static_assert(__is_trivially_copyable(T),
+                "Only trivially copyable types are supported");
+  static_assert(__is_trivially_constructible(T),
+                "Only trivially default constructible types are supported");
+
  public:
   using value_type = T;
 
-  optional() : no_value_placeholder_(), has_value_(false) {}
-  optional(T value) { emplace(move(value)); }
-  ~optional() { reset(); }
+  constexpr optional() : no_value_placeholder_(), has_value_(false) {}
+  constexpr optional(T value) : value_(value), has_value_(true) {}
+
+  constexpr bool has_value() const { return has_value_; }
+  constexpr operator bool() const { return has_value(); }
 
-  bool has_value() const { return has_value_; }
-  operator bool() const { return has_value(); }
+  constexpr const T& operator*() const& { return value_; }
+  constexpr T& operator*() & { return value_; }
 
-  const T& operator*() const& { return value_; }
-  T& operator*() & { return value_; }
-  const T&& operator*() const&& { return move(value_); }
-  T&& operator*() && { return move(value_); }
+  T* operator->() { return &value_; }
+  const T* operator->() const { return &value_; }
 
-  T* operator->() { return &**this; }
-  const T* operator->() const { return &**this; }
+  constexpr T value_or(T default_value) const {
+    return has_value_ ? value_ : default_value;
+  }
 
+  // Assigning to an inactive union member through a trivial assignment
+  // operator starts its lifetime if the member's type has a trivial default
+  // constructor ([class.union]), so no placement `new` is needed.
   template <typename... Args>
-  T& emplace(Args... args) {
-    if (exchange(has_value_, true)) {
-      value_.~T();
-    }
-    value_ = T(args...);
+  T& emplace(Args&&... args) {
+    value_ = T(forward<Args>(args)...);
+    has_value_ = true;
     return value_;
   }
 
-  void reset() {
-    if (exchange(has_value_, false)) {
-      value_.~T();
-    }
-    no_value_placeholder_ = {};
-  }
+  // The destructor of `T` is trivial, so it's enough to just drop the flag.
+  void reset() { has_value_ = false; }
 
  private:
   union {
@@ -88,6 +105,135 @@ class optional {
   bool has_value_;
 };
 
+// A fixed-size array, an aggregate just like a plain C array, but which can be
+// passed and returned by value.
+template <typename T, size_t N>
+struct array {
+  static_assert(N > 0, "Empty arrays are not supported");
+
+  using value_type = T;
+
+  constexpr static size_t size() { return N; }
+
+  constexpr T& operator[](size_t i) { return elements[i]; }
+  constexpr const T& operator[](size_t i) const { return elements[i]; }
+
+  constexpr T* data() { return elements; }
+  constexpr const T* data() const { return elements; }
+  constexpr T* begin() { return elements; }
+  constexpr const T* begin() const { return elements; }
+  constexpr T* end() { return elements + N; }
+  constexpr const T* end() const { return elements + N; }
+
+  // Public so that the struct remains an aggregate.
+  T elements[N];
+};
+
+// A non-owning view of a contiguous sequence of `T`. Use `span<const T>` for
+// read-only access.
+template <typename T>
+class span {
+ public:
+  using value_type = T;
+
+  constexpr span() : data_(nullptr), size_(0) {}
+  constexpr span(T* data, size_t size) : data_(data), size_(size) {}
+  template <size_t N>
+  constexpr span(T (&elements)[N]) : span(elements, N) {}
+  template <typename U, size_t N>
+  constexpr span(array<U, N>& elements) : span(elements.data(), N) {}
+  template <typename U, size_t N>
+  constexpr span(const array<U, N>& elements) : span(elements.data(), N) {}
+
+  constexpr size_t size() const { return size_; }
+  constexpr bool empty() const { return size_ == 0; }
+
+  constexpr T& operator[](size_t i) const { return data_[i]; }
+
+  constexpr T* data() const { return data_; }
+  constexpr T* begin() const { return data_; }
+  constexpr T* end() const { return data_ + size_; }
+
+  // Callers are responsible for `offset + count <= size()`.
+  constexpr span subspan(size_t offset, size_t count) const {
+    return span(data_ + offset, count);
+  }
+  constexpr span first(size_t count) const { return subspan(0, count); }
+  constexpr span last(size_t count) const {
+    return subspan(size_ - count, count);
+  }
+
+ private:
+  T* data_;
+  size_t size_;
+};
+
+// A single-producer, single-consumer FIFO queue of a fixed power-of-two
+// capacity. One side (typically an interrupt handler) only calls `Push`, the
+// other (typically the main loop) only calls `Pop`, and no locking is needed:
+// Each side only writes its own 8-bit index, which is read and written
+// atomically on AVR, and a compiler barrier orders the element access with
+// the index update.
+template <typename T, uint8_t Capacity>
+class RingBuffer {
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                "Capacity must be a power of 2");
+  static_assert(Capacity <= 128,
+                "Capacity must fit into a free-running 8-bit index");
+
+ public:
+  using value_type = T;
+
+  constexpr RingBuffer() : elements_(), head_(0), tail_(0) {}
+  RingBuffer(const RingBuffer&) = delete;
+  RingBuffer& operator=(const RingBuffer&) = delete;
+
+  constexpr static uint8_t capacity() { return Capacity; }
+
+  // Safe to be called from either side. The result might be outdated by the
+  // time it's used, but only in the direction favourable to the caller's
+  // side.
+  uint8_t Size() const { return static_cast<uint8_t>(head_ - tail_); }
+  bool IsEmpty() const { return Size() == 0; }
+  bool IsFull() const { return Size() == Capacity; }
+
+  // Producer side. Returns `false` (and drops `value`) if the buffer is full.
+  bool Push(const T& value) {
+    const uint8_t head = head_;
+    if (static_cast<uint8_t>(head - tail_) == Capacity) {
+      return false;
+    }
+    elements_[head & kMask] = value;
+    Barrier();
+    head_ = head + 1;
+    return true;
+  }
+
+  // Consumer side. Returns an empty value if the buffer is empty.
+  optional<T> Pop() {
+    const uint8_t tail = tail_;
+    if (head_ == tail) {
+      return {};
+    }
+    Barrier();
+    T value = elements_[tail & kMask];
+    Barrier();
+    tail_ = tail + 1;
+    return value;
+  }
+
+ private:
+  constexpr static uint8_t kMask = Capacity - 1;
+
+  static void Barrier() { __asm__ __volatile__("" ::: "memory"); }
+
+  T elements_[Capacity];
+  // Both indices run freely modulo 256, so that `head_ - tail_` is always the
+  // number of stored elements, distinguishing a full buffer from an empty one.
+  volatile uint8_t head_;
+  volatile uint8_t tail_;
+};
+
 // A fixed-width fraction. The default types allow to represent values within
 // [-1..1].
 template <typename T = int_fast16_t, uint8_t Bits = sizeof(T) * 8 - 2>